@@ -7,6 +7,7 @@
 #include <esp_log_level.h>
 #include <stdio.h>
 #include "esp_log.h"
+#include <app_priv.h>
 
 
 void matterLoggingCallbackErrorOnly(const char * module, uint8_t category, const char * msg, va_list args)
@@ -43,6 +44,7 @@ void matterLoggingCallback(const char * module, uint8_t category, const char * m
     case chip::Logging::kLogCategory_Error:
         {
             if (ESP_LOG_NONE != level_for_tag && ESP_LOG_ERROR <= level_for_tag) {
+                    app_stats_log_message();
                     printf(LOG_COLOR_E "E (%" PRIu32 ") %s: ", esp_log_timestamp(), tag);
                     esp_log_writev(ESP_LOG_ERROR, tag, msg, v);
                     printf(LOG_RESET_COLOR "\n");
@@ -54,6 +56,7 @@ void matterLoggingCallback(const char * module, uint8_t category, const char * m
     default: 
         {
             if (ESP_LOG_NONE != level_for_tag && ESP_LOG_INFO <= level_for_tag) {
+                app_stats_log_message();
                 printf(LOG_COLOR_I "I (%" PRIu32 ") %s: ", esp_log_timestamp(), tag);
                 esp_log_writev(ESP_LOG_INFO, tag, msg, v);
                 printf(LOG_RESET_COLOR "\n");
@@ -64,6 +67,7 @@ void matterLoggingCallback(const char * module, uint8_t category, const char * m
     case chip::Logging::kLogCategory_Detail:
         {
             if (ESP_LOG_NONE != level_for_tag && ESP_LOG_DEBUG <= level_for_tag) {
+                app_stats_log_message();
                 printf(LOG_COLOR_D "D (%" PRIu32 ") %s: ", esp_log_timestamp(), tag);
                 esp_log_writev(ESP_LOG_DEBUG, tag, msg, v);
                 printf(LOG_RESET_COLOR "\n");
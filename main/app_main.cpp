@@ -4,6 +4,7 @@
 
 #include <esp_err.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <nvs_flash.h>
 
 #include <esp_matter.h>
@@ -30,6 +31,7 @@ using namespace esp_matter::endpoint;
 using namespace chip::app::Clusters;
 
 constexpr auto k_timeout_seconds = 300;
+constexpr auto k_recovery_timeout_seconds = 10;
 
 #if CONFIG_ENABLE_ENCRYPTED_OTA
 extern const char decryption_key_start[] asm("_binary_esp_image_encryption_key_pem_start");
@@ -39,6 +41,65 @@ static const char *s_decryption_key = decryption_key_start;
 static const uint16_t s_decryption_key_len = decryption_key_end - decryption_key_start;
 #endif // CONFIG_ENABLE_ENCRYPTED_OTA
 
+// Recovery after last fabric removed: start time, 0 if not in progress
+static int64_t s_recovery_start_us = 0;
+
+static void recovery_timeout_cb(chip::System::Layer *layer, void *app_state)
+{
+    ESP_LOGE(TAG, "Commissioning window not opened in %d s, restart", k_recovery_timeout_seconds);
+    esp_restart();
+}
+
+// Commissioning window is open, stop recovery timer
+static void recovery_done()
+{
+    if (s_recovery_start_us != 0) {
+        chip::DeviceLayer::SystemLayer().CancelTimer(recovery_timeout_cb, nullptr);
+        ESP_LOGI(TAG, "Recovery time: %lld ms", (esp_timer_get_time() - s_recovery_start_us) / 1000);
+        s_recovery_start_us = 0;
+    }
+}
+
+// Reset network and commissioning without reboot, light keeps its state
+static void reset_to_commissioning()
+{
+    s_recovery_start_us = esp_timer_get_time();
+
+    // Initialise BLE manager
+    CHIP_ERROR err = chip::DeviceLayer::Internal::BLEMgr().Init();
+    if (err != CHIP_NO_ERROR) {
+        // BLE memory is already released, commissioning needs a fresh boot
+        ESP_LOGE(TAG, "BLEManager initialization failed: %" CHIP_ERROR_FORMAT ", restart", err.Format());
+        esp_restart();
+    }
+    // Clear Wifi credentials if any
+    if (chip::DeviceLayer::ConnectivityMgr().IsWiFiStationProvisioned()) {
+        ESP_LOGI(TAG, "ClearWiFiStationProvision");
+        chip::DeviceLayer::ConnectivityMgr().ClearWiFiStationProvision();
+    }
+    // Clear Thread provision if any, Thread stack is disabled
+    if (chip::DeviceLayer::ConnectivityMgr().IsThreadProvisioned()) {
+        ESP_LOGI(TAG, "ErasePersistentInfo");
+        chip::DeviceLayer::ConnectivityMgr().ErasePersistentInfo();
+    }
+
+    // Advertise over BLE
+    chip::CommissioningWindowManager & commissionMgr = chip::Server::GetInstance().GetCommissioningWindowManager();
+    if (commissionMgr.IsCommissioningWindowOpen()) {
+        recovery_done();
+        return;
+    }
+    constexpr auto kTimeoutSeconds = chip::System::Clock::Seconds16(k_timeout_seconds);
+    chip::DeviceLayer::ConnectivityMgr().SetBLEAdvertisingEnabled(true);
+    err = commissionMgr.OpenBasicCommissioningWindow(kTimeoutSeconds);
+    if (err != CHIP_NO_ERROR) {
+        ESP_LOGE(TAG, "Failed to open commissioning window: %" CHIP_ERROR_FORMAT ", restart", err.Format());
+        esp_restart();
+    }
+    // Fallback to restart if commissioning window opened event does not come in time
+    chip::DeviceLayer::SystemLayer().StartTimer(chip::System::Clock::Seconds32(k_recovery_timeout_seconds), recovery_timeout_cb, nullptr);
+}
+
 static void app_event_cb(const ChipDeviceEvent *event, intptr_t arg)
 {
     switch (event->Type) {
@@ -111,6 +172,7 @@ static void app_event_cb(const ChipDeviceEvent *event, intptr_t arg)
 
     case chip::DeviceLayer::DeviceEventType::kCommissioningWindowOpened:
         ESP_LOGI(TAG, "Commissioning window opened");
+        recovery_done();
         break;
 
     case chip::DeviceLayer::DeviceEventType::kCommissioningWindowClosed:
@@ -123,33 +185,7 @@ static void app_event_cb(const ChipDeviceEvent *event, intptr_t arg)
             if (chip::Server::GetInstance().GetFabricTable().FabricCount() == 0)
             {
                 ESP_LOGI(TAG, "Last fabric removed");
-                // Initialise BLE manager
-                CHIP_ERROR err = chip::DeviceLayer::Internal::BLEMgr().Init();
-                if (err != CHIP_NO_ERROR) {
-                    ESP_LOGE(TAG, "BLEManager initialization failed: %" CHIP_ERROR_FORMAT, err.Format());
-                }  
-                // Clear Wifi credentials if any
-                if (chip::DeviceLayer::ConnectivityMgr().IsWiFiStationProvisioned()) {
-                    ESP_LOGI(TAG, "ClearWiFiStationProvision");
-                    chip::DeviceLayer::ConnectivityMgr().ClearWiFiStationProvision();
-                }
-                // Clear Thread provision if any
-                if (chip::DeviceLayer::ConnectivityMgr().IsThreadProvisioned()) {
-                    ESP_LOGI(TAG, "ErasePersistentInfo");
-                    chip::DeviceLayer::ConnectivityMgr().ErasePersistentInfo();
-                }
-                esp_restart();
-                // if (!commissionMgr.IsCommissioningWindowOpen())
-                // {
-				    // Advertise over BLE
-                    // chip::CommissioningWindowManager & commissionMgr = chip::Server::GetInstance().GetCommissioningWindowManager();
-                    // constexpr auto kTimeoutSeconds = chip::System::Clock::Seconds16(k_timeout_seconds);
-                    // chip::DeviceLayer::ConnectivityMgr().SetBLEAdvertisingEnabled(true);
-                    // err = commissionMgr.OpenBasicCommissioningWindow(kTimeoutSeconds);
-                    // if (err != CHIP_NO_ERROR) {
-                    //     ESP_LOGE(TAG, "Failed to open commissioning window: %" CHIP_ERROR_FORMAT, err.Format());
-                    // }
-                // }
+                reset_to_commissioning();
             }
         break;
         }
@@ -202,11 +238,15 @@ static esp_err_t app_attribute_update_cb(attribute::callback_type_t type,
                                          esp_matter_attr_val_t *val, 
                                          void *priv_data)
 {
+    // Own stats updates would fill the capture ring
+    if (cluster_id != LIGHT_STATS_CLUSTER_ID) {
+        app_capture_record(type, endpoint_id, cluster_id, attribute_id, val);
+    }
     if (type != PRE_UPDATE) {
         return ESP_OK;
     }
-    /* Driver update */
-    if (endpoint_id != light_endpoint_id) {
+    /* Driver update, button changes are already in the driver */
+    if (endpoint_id != light_endpoint_id || app_driver_button_syncing()) {
         return ESP_OK;
     }
     app_driver_attribute_update(cluster_id, attribute_id, val);
@@ -243,6 +283,9 @@ extern "C" void app_main()
     /* Initialize the ESP NVS layer */
     nvs_flash_init();
 
+    /* Count quick power cycles */
+    app_power_cycle_init();
+
     /* Initialize led driver */
     app_driver_light_init();
 
@@ -281,6 +324,9 @@ extern "C" void app_main()
     
     light_endpoint_id = endpoint::get_id(endpoint);
     ESP_LOGI(TAG, "Light created with endpoint_id %d", light_endpoint_id);
+
+    /* Driver performance counters */
+    app_stats_create_cluster(endpoint);
  
     /* Mark deferred persistence for some attributes that might be changed rapidly */
     cluster_t *level_control_cluster = cluster::get(endpoint, LevelControl::Id);
@@ -326,6 +372,8 @@ extern "C" void app_main()
     /* Starting driver with default values */
     app_driver_light_set_defaults(light_endpoint_id);
 
+    app_power_cycle_process();
+
 #if CONFIG_ENABLE_ENCRYPTED_OTA
     err = esp_matter_ota_requestor_encrypted_init(s_decryption_key, s_decryption_key_len);
     ABORT_APP_ON_FAILURE(err == ESP_OK, ESP_LOGE(TAG, "Failed to initialized the encrypted OTA, err: %d", err));
@@ -343,6 +391,7 @@ extern "C" void app_main()
     esp_matter::console::diagnostics_register_commands();
     esp_matter::console::wifi_register_commands();
     esp_matter::console::factoryreset_register_commands();
+    app_console_register_commands();
 #if CONFIG_OPENTHREAD_CLI
     esp_matter::console::otcli_register_commands();
 #endif
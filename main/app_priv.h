@@ -24,6 +24,19 @@
 
 typedef void *app_driver_handle_t;
 
+/** Light stats manufacturer-specific cluster, test vendor 0xFFF2 */
+#define LIGHT_STATS_CLUSTER_ID              0xFFF2FC00
+#define LIGHT_STATS_UPTIME                  0x0000  // uint32, s
+#define LIGHT_STATS_ATTRIBUTE_UPDATES       0x0001  // uint32, light attribute updates
+#define LIGHT_STATS_UPDATES_PER_SECOND      0x0002  // uint16, average for the last period
+#define LIGHT_STATS_FADES_STARTED           0x0003  // uint32
+#define LIGHT_STATS_FADES_COALESCED         0x0004  // uint32, skipped for a newer fade
+#define LIGHT_STATS_FADES_DROPPED           0x0005  // uint32, fade not sent, not expected with the fade mailbox
+#define LIGHT_STATS_NVS_COMMITS             0x0006  // uint32
+#define LIGHT_STATS_LOG_MESSAGES            0x0007  // uint32, Matter log messages printed
+#define LIGHT_STATS_LATENCY_HISTOGRAM       0x0008  // octet string, 8 x uint32 LE, attribute to PWM latency, bin n < 250 us << n
+#define LIGHT_STATS_FADE_TIME_HISTOGRAM     0x0009  // octet string, 8 x uint32 LE, fade time, bin n < 25 ms << n
+
 /** Initialize the light driver
  *
  * This initializes the light driver associated with the selected board.
@@ -38,6 +51,15 @@ void app_driver_light_init();
  */
 void app_driver_button_init(uint16_t *light_endpoint_id);
 
+/** Button data model sync in progress
+ *
+ * The light driver already has the synced state, skip the driver update.
+ *
+ * @return true inside the button sync, in the Matter thread.
+ *
+ */
+bool app_driver_button_syncing();
+
 /** Driver Update
  *
  * This API should be called to update the driver for the attribute being updated.
@@ -61,6 +83,130 @@ void app_driver_attribute_update(uint32_t cluster_id,
  */
 void app_driver_light_set_defaults(uint16_t endpoint_id);
 
+/** Local light control
+ *
+ * Drive PWM immediately, bypassing the Matter data model. Used by the button driver,
+ * which syncs data model asynchronously with `app_driver_light_get_state()`.
+ *
+ * @param[in] power New power state.
+ * @param[in] stamp Low 32 bits of `esp_timer_get_time()` at the press, for latency log, 0 if not used.
+ *
+ */
+void app_driver_light_local_set_power(bool power, uint32_t stamp);
+
+/** Local color temperature control
+ *
+ * @param[in] mireds Color temperature in mireds.
+ *
+ */
+void app_driver_light_local_set_temperature(uint16_t mireds);
+
+/** Start dimming
+ *
+ * Fade brightness to max or min level. Ignored when light is off.
+ * One hardware fade, or timer steps on targets without LEDC fade stop (ESP32).
+ *
+ * @param[in] up Dimming direction.
+ * @param[in] time_ms Fade time for the full brightness range.
+ *
+ */
+void app_driver_light_dim_start(bool up, uint32_t time_ms);
+
+/** Stop dimming
+ *
+ * Stop dimming and keep the reached brightness.
+ *
+ */
+void app_driver_light_dim_stop();
+
+/** Get fade backlog
+ *
+ * @return Fades waiting in the fade task mailbox, 0 or 1.
+ *
+ */
+uint32_t app_driver_light_fade_backlog();
+
+/** Get current light state
+ *
+ * @param[out] power Power state.
+ * @param[out] brightness Brightness level.
+ * @param[out] mireds Color temperature in mireds.
+ *
+ */
+void app_driver_light_get_state(bool *power, uint8_t *brightness, uint16_t *mireds);
+
+/** Count power cycles
+ *
+ * Count brown-out cycles in RTC memory, call early at boot.
+ *
+ */
+void app_power_cycle_init();
+
+/** Process power cycles
+ *
+ * Count full power off cycles from the Matter reboot counter, start the action
+ * after N quick power cycles or the stable power timer.
+ * Call after Matter start.
+ *
+ */
+void app_power_cycle_process();
+
+/** Create light stats cluster
+ *
+ * Create the manufacturer-specific cluster with driver performance counters
+ * and start periodic counters publishing.
+ *
+ * @param[in] endpoint Light endpoint.
+ *
+ */
+void app_stats_create_cluster(esp_matter::endpoint_t *endpoint);
+
+/** Light stats hot path counters, cheap to call from any context */
+void app_stats_attribute_update();
+void app_stats_fade(uint32_t latency_us, uint32_t fade_time_ms, uint32_t coalesced);
+void app_stats_fade_dropped();
+void app_stats_log_message();
+
+/** Get light stats counter
+ *
+ * @param[in] attribute_id Counter attribute ID, `LIGHT_STATS_*`.
+ *
+ * @return Counter value.
+ *
+ */
+uint32_t app_stats_get(uint32_t attribute_id);
+
+/** Light bench shell command handler */
+esp_err_t app_light_bench_command(int argc, char **argv);
+
+/** Captured `app_attribute_update_cb` invocation */
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp;         // esp_timer_get_time() low 32 bits, us
+    uint32_t cluster_id;
+    uint32_t attribute_id;
+    uint32_t value;             // zero extended integer or float bits
+    uint16_t endpoint_id;
+    uint8_t type;               // attribute::callback_type_t
+    uint8_t val_type;           // esp_matter_val_type_t
+} capture_record_t;
+
+/** Capture dump: header line with records count, record per line in hex, end line */
+#define CAPTURE_DUMP_HEADER "LIGHT CAPTURE"
+#define CAPTURE_DUMP_END "LIGHT CAPTURE END"
+
+/** Capture attribute update
+ *
+ * Record attribute update callback invocation, if capture is started by the shell.
+ *
+ */
+void app_capture_record(uint8_t type, uint16_t endpoint_id, uint32_t cluster_id, uint32_t attribute_id, esp_matter_attr_val_t *val);
+
+/** Capture shell command handler */
+esp_err_t app_capture_command(int argc, char **argv);
+
+/** Register light shell commands */
+void app_console_register_commands();
+
 // Matter (chip) modules logging
 void matterLoggingCallback(const char * module, uint8_t category, const char * msg, va_list args);
 
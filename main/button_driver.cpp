@@ -1,14 +1,18 @@
 /*
     On-board button driver
+    Click: on/off, double click: color temperature presets,
+    press and hold: dimming, hold 5 s: factory reset
 */
 
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <esp_matter.h>
 #include <common_macros.h>
 #include <iot_button.h>
+#include <platform/CHIPDeviceLayer.h>
 #include <app_priv.h>
 
 
@@ -19,6 +23,21 @@ static const char *TAG = "button_driver";
 
 static bool perform_factory_reset = false;
 
+// Gesture state, changed in the button timer context only
+static bool turned_on_by_press = false;
+static bool off_pending = false;
+static bool dimming = false;
+static bool dim_up = true;
+static int cct_preset = 0;
+// Set in the Matter thread only
+static bool syncing = false;
+
+static const uint16_t cct_presets[] = {
+    REMAP_TO_RANGE_INVERSE(CONFIG_COLOR_TEMP_WARM, MATTER_TEMPERATURE_FACTOR),
+    REMAP_TO_RANGE_INVERSE(CONFIG_COLOR_TEMP_DEFAULT, MATTER_TEMPERATURE_FACTOR),
+    REMAP_TO_RANGE_INVERSE(CONFIG_COLOR_TEMP_COLD, MATTER_TEMPERATURE_FACTOR),
+};
+
 static const button_config_t button_config = {
     .type = BUTTON_TYPE_GPIO,
     .gpio_button_config = {
@@ -27,48 +46,113 @@ static const button_config_t button_config = {
     },
 };
 
-static void app_driver_button_toggle_cb(void *arg, void *data)
+// Runs in the Matter thread: update data model from the driver state
+static void app_driver_button_sync(intptr_t arg)
 {
-    ESP_LOGI(TAG, "Toggle button pressed");
-    uint16_t endpoint_id = *(uint16_t *)data;
-    uint32_t cluster_id = OnOff::Id;
-    uint32_t attribute_id = OnOff::Attributes::OnOff::Id;
-
-    attribute_t *attribute = attribute::get(endpoint_id, cluster_id, attribute_id);
-
-    esp_matter_attr_val_t val = esp_matter_invalid(NULL);
-    attribute::get_val(attribute, &val);
-    val.val.b = !val.val.b;
-    attribute::update(endpoint_id, cluster_id, attribute_id, &val);
-
-    if (val.val.b) {
-        cluster_id = LevelControl::Id;
-        attribute_id = LevelControl::Attributes::CurrentLevel::Id;
-        attribute = attribute::get(endpoint_id, cluster_id, attribute_id);
-        attribute::get_val(attribute, &val);
-        auto level = val.val.u8;
-        val.val.u8 = 1;
-        attribute::update(endpoint_id, cluster_id, attribute_id, &val);
-        val.val.u8 = level;
-        attribute::update(endpoint_id, cluster_id, attribute_id, &val);
-    }
+    uint16_t endpoint_id = *(uint16_t *)arg;
+    bool power;
+    uint8_t brightness;
+    uint16_t mireds;
+    app_driver_light_get_state(&power, &brightness, &mireds);
+
+    syncing = true;
+    esp_matter_attr_val_t val = esp_matter_bool(power);
+    attribute::update(endpoint_id, OnOff::Id, OnOff::Attributes::OnOff::Id, &val);
+    val = esp_matter_nullable_uint8(brightness);
+    attribute::update(endpoint_id, LevelControl::Id, LevelControl::Attributes::CurrentLevel::Id, &val);
+    val = esp_matter_uint16(mireds);
+    attribute::update(endpoint_id, ColorControl::Id, ColorControl::Attributes::ColorTemperatureMireds::Id, &val);
+    syncing = false;
 }
 
+bool app_driver_button_syncing()
+{
+    return syncing;
+}
 
-static void button_factory_reset_pressed_cb(void *arg, void *data)
+static void app_driver_button_schedule_sync(void *data)
 {
-    if (!perform_factory_reset) {
-        ESP_LOGI(TAG, "Factory reset triggered. Release the button to start factory reset.");
-        perform_factory_reset = true;
+    chip::DeviceLayer::PlatformMgr().ScheduleWork(app_driver_button_sync, (intptr_t)data);
+}
+
+// Press turns the light on at once, single click turns it off, unless dimming
+static void app_driver_button_press_cb(void *arg, void *data)
+{
+    uint32_t stamp = esp_timer_get_time();
+    off_pending = false;
+    bool power;
+    uint8_t brightness;
+    uint16_t mireds;
+    app_driver_light_get_state(&power, &brightness, &mireds);
+    turned_on_by_press = !power;
+    if (turned_on_by_press) {
+        ESP_LOGI(TAG, "Button: on");
+        app_driver_light_local_set_power(true, stamp);
+        app_driver_button_schedule_sync(data);
     }
 }
 
-static void button_factory_reset_released_cb(void *arg, void *data)
+static void app_driver_button_release_cb(void *arg, void *data)
 {
     if (perform_factory_reset) {
         ESP_LOGI(TAG, "Starting factory reset");
         esp_matter::factory_reset();
         perform_factory_reset = false;
+        return;
+    }
+    if (dimming) {
+        dimming = false;
+        app_driver_light_dim_stop();
+        app_driver_button_schedule_sync(data);
+    } else {
+        off_pending = !turned_on_by_press;
+    }
+}
+
+// Comes after the double click window, so the first click of a double click does not blink the light
+static void app_driver_button_single_click_cb(void *arg, void *data)
+{
+    if (off_pending) {
+        off_pending = false;
+        ESP_LOGI(TAG, "Button: off");
+        app_driver_light_local_set_power(false, esp_timer_get_time());
+        app_driver_button_schedule_sync(data);
+    }
+}
+
+// Press and hold: dim up or down, direction alternates
+static void app_driver_button_dim_cb(void *arg, void *data)
+{
+    bool power;
+    uint8_t brightness;
+    uint16_t mireds;
+    app_driver_light_get_state(&power, &brightness, &mireds);
+    if (brightness >= MATTER_BRIGHTNESS) {
+        dim_up = false;
+    } else if (brightness <= 1) {
+        dim_up = true;
+    } else {
+        dim_up = !dim_up;
+    }
+    dimming = true;
+    app_driver_light_dim_start(dim_up, CONFIG_BUTTON_DIM_TIME);
+}
+
+// Double click: next color temperature preset, light on
+static void app_driver_button_double_click_cb(void *arg, void *data)
+{
+    cct_preset = (cct_preset + 1) % (sizeof(cct_presets) / sizeof(cct_presets[0]));
+    ESP_LOGI(TAG, "Button: color temperature preset %d", cct_preset);
+    app_driver_light_local_set_temperature(cct_presets[cct_preset]);
+    app_driver_light_local_set_power(true, 0);
+    app_driver_button_schedule_sync(data);
+}
+
+static void button_factory_reset_pressed_cb(void *arg, void *data)
+{
+    if (!perform_factory_reset) {
+        ESP_LOGI(TAG, "Factory reset triggered. Release the button to start factory reset.");
+        perform_factory_reset = true;
     }
 }
 
@@ -76,8 +160,18 @@ void app_driver_button_init(uint16_t *light_endpoint_id) {
 	button_handle_t button_handle = iot_button_create(&button_config);
     ABORT_APP_ON_FAILURE(button_handle != nullptr, ESP_LOGE(TAG, "Failed to create button handle"));
 	esp_err_t err = ESP_OK;
-	err |= iot_button_register_cb(button_handle, BUTTON_PRESS_DOWN, app_driver_button_toggle_cb, light_endpoint_id);
-    err |= iot_button_register_cb(button_handle, BUTTON_LONG_PRESS_HOLD, button_factory_reset_pressed_cb, NULL);
-    err |= iot_button_register_cb(button_handle, BUTTON_PRESS_UP, button_factory_reset_released_cb, NULL);
+    button_event_config_t dim_config = {};
+    dim_config.event = BUTTON_LONG_PRESS_START;
+    dim_config.event_data.long_press.press_time = CONFIG_BUTTON_DIM_PRESS_TIME;
+    // Own long press time: the dim event lowers the LONG_PRESS_HOLD threshold to the dim press time
+    button_event_config_t factory_reset_config = {};
+    factory_reset_config.event = BUTTON_LONG_PRESS_START;
+    factory_reset_config.event_data.long_press.press_time = CONFIG_BUTTON_LONG_PRESS_TIME_MS;
+	err |= iot_button_register_cb(button_handle, BUTTON_PRESS_DOWN, app_driver_button_press_cb, light_endpoint_id);
+    err |= iot_button_register_cb(button_handle, BUTTON_PRESS_UP, app_driver_button_release_cb, light_endpoint_id);
+    err |= iot_button_register_cb(button_handle, BUTTON_SINGLE_CLICK, app_driver_button_single_click_cb, light_endpoint_id);
+    err |= iot_button_register_cb(button_handle, BUTTON_DOUBLE_CLICK, app_driver_button_double_click_cb, light_endpoint_id);
+    err |= iot_button_register_event_cb(button_handle, dim_config, app_driver_button_dim_cb, light_endpoint_id);
+    err |= iot_button_register_event_cb(button_handle, factory_reset_config, button_factory_reset_pressed_cb, NULL);
     ESP_ERROR_CHECK(err);
 }
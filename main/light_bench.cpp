@@ -0,0 +1,204 @@
+/*
+    Light pipeline self-benchmark shell commands
+    Results are printed as "<test>,target=<chip>,key=value,..." lines
+*/
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <nvs.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include <esp_matter.h>
+#include <app_priv.h>
+#include <lib/support/logging/Constants.h>
+
+#if CONFIG_LIGHT_BENCH
+using namespace chip::app::Clusters;
+
+extern uint16_t light_endpoint_id;
+
+// Idle tasks run time, us, 0 if run time stats are disabled
+static uint32_t bench_idle_time()
+{
+    uint32_t idle = 0;
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    UBaseType_t count = uxTaskGetNumberOfTasks() + 4;
+    TaskStatus_t *tasks = (TaskStatus_t *)malloc(count * sizeof(TaskStatus_t));
+    if (tasks == nullptr) {
+        return 0;
+    }
+    count = uxTaskGetSystemState(tasks, count, nullptr);
+    for (UBaseType_t i = 0; i < count; i++) {
+        if (strncmp(tasks[i].pcTaskName, "IDLE", 4) == 0) {
+            idle += tasks[i].ulRunTimeCounter;
+        }
+    }
+    free(tasks);
+#endif
+    return idle;
+}
+
+// Synthetic level and color temperature updates at the given rate
+static esp_err_t bench_sweep(uint32_t rate, uint32_t seconds)
+{
+    uint16_t miredsMin = REMAP_TO_RANGE_INVERSE(CONFIG_COLOR_TEMP_COLD, MATTER_TEMPERATURE_FACTOR);
+    uint16_t miredsMax = REMAP_TO_RANGE_INVERSE(CONFIG_COLOR_TEMP_WARM, MATTER_TEMPERATURE_FACTOR);
+    uint32_t startFades = app_stats_get(LIGHT_STATS_FADES_STARTED);
+    uint32_t startCoalesced = app_stats_get(LIGHT_STATS_FADES_COALESCED);
+    uint32_t startDropped = app_stats_get(LIGHT_STATS_FADES_DROPPED);
+
+    // Measure the pipeline, not the console
+    esp_log_level_t logLevel = esp_log_level_get("led_driver");
+    esp_log_level_set("led_driver", ESP_LOG_WARN);
+    app_driver_light_local_set_power(true, 0);
+
+    uint32_t updates = 0;
+    int64_t callTotal = 0;
+    int64_t callMax = 0;
+    uint32_t maxBacklog = 0;
+    uint64_t backlogSum = 0;
+    uint32_t samples = 0;
+    int64_t duration = int64_t(seconds) * 1000000;
+    uint32_t startIdle = bench_idle_time();
+    int64_t start = esp_timer_get_time();
+    int64_t elapsed;
+    while ((elapsed = esp_timer_get_time() - start) < duration) {
+        uint32_t due = elapsed * rate / 1000000;
+        while (updates < due) {
+            esp_matter_attr_val_t val;
+            int64_t callStart = esp_timer_get_time();
+            if (updates % 2 == 0) {
+                val = esp_matter_nullable_uint8(1 + (updates / 2) % MATTER_BRIGHTNESS);
+                app_driver_attribute_update(LevelControl::Id, LevelControl::Attributes::CurrentLevel::Id, &val);
+            } else {
+                val = esp_matter_uint16(miredsMin + (updates / 2) % (miredsMax - miredsMin + 1));
+                app_driver_attribute_update(ColorControl::Id, ColorControl::Attributes::ColorTemperatureMireds::Id, &val);
+            }
+            int64_t callTime = esp_timer_get_time() - callStart;
+            callTotal += callTime;
+            callMax = std::max(callMax, callTime);
+            updates++;
+        }
+        uint32_t backlog = app_driver_light_fade_backlog();
+        maxBacklog = std::max(maxBacklog, backlog);
+        backlogSum += backlog;
+        samples++;
+        vTaskDelay(1);
+    }
+    uint32_t idle = bench_idle_time() - startIdle;
+
+    esp_log_level_set("led_driver", logLevel);
+    /* Restore light state from the data model */
+    chip::DeviceLayer::PlatformMgr().LockChipStack();
+    app_driver_light_set_defaults(light_endpoint_id);
+    chip::DeviceLayer::PlatformMgr().UnlockChipStack();
+
+    int cpuLoad = -1;
+    if (idle != 0) {
+        cpuLoad = 100 - int(uint64_t(idle) * 100 / (uint64_t(elapsed) * portNUM_PROCESSORS));
+    }
+    // Updates are paced, so the driver capacity comes from the update call time, not from the update count
+    int64_t callAvgNs = updates ? callTotal * 1000 / updates : 0;
+    printf("sweep,target=%s,rate=%lu,seconds=%lu,updates=%lu,call_avg_ns=%lld,call_max_us=%lld,max_rate=%lld,"
+           "fades=%lu,coalesced=%lu,dropped=%lu,backlog_max=%lu,backlog_avg=%.2f,cpu_load=%d\n",
+           CONFIG_IDF_TARGET, rate, seconds, updates, callAvgNs, callMax, callAvgNs ? 1000000000 / callAvgNs : 0,
+           app_stats_get(LIGHT_STATS_FADES_STARTED) - startFades,
+           app_stats_get(LIGHT_STATS_FADES_COALESCED) - startCoalesced,
+           app_stats_get(LIGHT_STATS_FADES_DROPPED) - startDropped,
+           maxBacklog, samples ? double(backlogSum) / samples : 0.0, cpuLoad);
+    return ESP_OK;
+}
+
+// NVS set and commit latency
+static esp_err_t bench_nvs(uint32_t iterations)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open("light_bench", NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    int64_t min = INT64_MAX;
+    int64_t max = 0;
+    int64_t total = 0;
+    for (uint32_t i = 0; i < iterations && err == ESP_OK; i++) {
+        int64_t start = esp_timer_get_time();
+        err = nvs_set_u32(handle, "counter", i);
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        int64_t time = esp_timer_get_time() - start;
+        min = std::min(min, time);
+        max = std::max(max, time);
+        total += time;
+    }
+    nvs_erase_all(handle);
+    nvs_commit(handle);
+    nvs_close(handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    printf("nvs,target=%s,iterations=%lu,commit_min_us=%lld,commit_avg_us=%lld,commit_max_us=%lld\n",
+           CONFIG_IDF_TARGET, iterations, min, total / iterations, max);
+    return ESP_OK;
+}
+
+static void bench_log_message(const char *module, uint8_t category, const char *msg, ...)
+{
+    va_list args;
+    va_start(args, msg);
+    matterLoggingCallback(module, category, msg, args);
+    va_end(args);
+}
+
+// Matter log callback cost: message filtered by level and printed
+static esp_err_t bench_log(uint32_t iterations)
+{
+    // DMG progress is filtered in setupLogging()
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        bench_log_message("DMG", chip::Logging::kLogCategory_Progress, "Bench %lu", i);
+    }
+    int64_t filtered = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        bench_log_message("BNC", chip::Logging::kLogCategory_Progress, "Bench %lu", i);
+    }
+    int64_t printed = esp_timer_get_time() - start;
+
+    printf("log,target=%s,iterations=%lu,filtered_ns=%lld,printed_ns=%lld\n",
+           CONFIG_IDF_TARGET, iterations, filtered * 1000 / iterations, printed * 1000 / iterations);
+    return ESP_OK;
+}
+
+esp_err_t app_light_bench_command(int argc, char **argv)
+{
+    if (argc >= 1 && strcmp(argv[0], "sweep") == 0) {
+        uint32_t rate = argc >= 2 ? strtoul(argv[1], nullptr, 0) : 50;
+        uint32_t seconds = argc >= 3 ? strtoul(argv[2], nullptr, 0) : 10;
+        if (rate == 0 || seconds == 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        return bench_sweep(rate, seconds);
+    }
+    if (argc >= 1 && strcmp(argv[0], "nvs") == 0) {
+        uint32_t iterations = argc >= 2 ? strtoul(argv[1], nullptr, 0) : 20;
+        if (iterations == 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        return bench_nvs(iterations);
+    }
+    if (argc >= 1 && strcmp(argv[0], "log") == 0) {
+        uint32_t iterations = argc >= 2 ? strtoul(argv[1], nullptr, 0) : 100;
+        if (iterations == 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        return bench_log(iterations);
+    }
+    printf("light bench sweep [rate/s] [seconds] | nvs [iterations] | log [iterations]\n");
+    return ESP_OK;
+}
+#endif // CONFIG_LIGHT_BENCH
@@ -0,0 +1,147 @@
+/*
+    Attribute update workload capture
+    Compact binary ring of app_attribute_update_cb invocations, dumped by the shell
+    for host replay, see tools/replay
+*/
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+#include <esp_matter.h>
+#include <app_priv.h>
+
+static const char *TAG = "light_capture";
+
+static capture_record_t *captureRing;
+static uint32_t captureSize;
+static uint32_t captureHead;
+static uint32_t captureCount;
+// Checked without the lock first, set and checked again under captureMux
+static std::atomic<bool> captureActive;
+static portMUX_TYPE captureMux = portMUX_INITIALIZER_UNLOCKED;
+
+void app_capture_record(uint8_t type, uint16_t endpoint_id, uint32_t cluster_id, uint32_t attribute_id, esp_matter_attr_val_t *val)
+{
+    if (!captureActive) {
+        return;
+    }
+    capture_record_t record;
+    record.timestamp = esp_timer_get_time();
+    record.cluster_id = cluster_id;
+    record.attribute_id = attribute_id;
+    record.endpoint_id = endpoint_id;
+    record.type = type;
+    record.val_type = val->type;
+    // Zero extended, replay reads it as any integer type
+    switch (val->type & ~ESP_MATTER_VAL_NULLABLE_BASE) {
+    case ESP_MATTER_VAL_TYPE_BOOLEAN:
+        record.value = val->val.b;
+        break;
+    case ESP_MATTER_VAL_TYPE_INT8:
+    case ESP_MATTER_VAL_TYPE_UINT8:
+    case ESP_MATTER_VAL_TYPE_ENUM8:
+    case ESP_MATTER_VAL_TYPE_BITMAP8:
+        record.value = val->val.u8;
+        break;
+    case ESP_MATTER_VAL_TYPE_INT16:
+    case ESP_MATTER_VAL_TYPE_UINT16:
+    case ESP_MATTER_VAL_TYPE_ENUM16:
+    case ESP_MATTER_VAL_TYPE_BITMAP16:
+        record.value = val->val.u16;
+        break;
+    case ESP_MATTER_VAL_TYPE_INT32:
+    case ESP_MATTER_VAL_TYPE_UINT32:
+    case ESP_MATTER_VAL_TYPE_BITMAP32:
+    case ESP_MATTER_VAL_TYPE_FLOAT:
+        memcpy(&record.value, &val->val, sizeof(record.value));
+        break;
+    default:
+        record.value = 0;
+        break;
+    }
+
+    portENTER_CRITICAL(&captureMux);
+    if (captureActive) {
+        captureRing[captureHead] = record;
+        captureHead = (captureHead + 1) % captureSize;
+        if (captureCount < captureSize) {
+            captureCount++;
+        }
+    }
+    portEXIT_CRITICAL(&captureMux);
+}
+
+static void app_capture_dump()
+{
+    portENTER_CRITICAL(&captureMux);
+    bool active = captureActive;
+    captureActive = false;
+    portEXIT_CRITICAL(&captureMux);
+    // Oldest record first
+    uint32_t index = (captureHead + captureSize - captureCount) % captureSize;
+    printf(CAPTURE_DUMP_HEADER " %lu\n", captureCount);
+    for (uint32_t i = 0; i < captureCount; i++) {
+        const uint8_t *data = (const uint8_t *)&captureRing[index];
+        for (int byte = 0; byte < sizeof(capture_record_t); byte++) {
+            printf("%02x", data[byte]);
+        }
+        printf("\n");
+        index = (index + 1) % captureSize;
+    }
+    printf(CAPTURE_DUMP_END "\n");
+    captureActive = active;
+}
+
+esp_err_t app_capture_command(int argc, char **argv)
+{
+    if (argc >= 1 && strcmp(argv[0], "start") == 0) {
+        uint32_t size = argc >= 2 ? strtoul(argv[1], nullptr, 0) : CONFIG_LIGHT_CAPTURE_SIZE;
+        if (size == 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        capture_record_t *oldRing = nullptr;
+        capture_record_t *newRing = nullptr;
+        if (captureRing == nullptr || size != captureSize) {
+            newRing = (capture_record_t *)malloc(size * sizeof(capture_record_t));
+            if (newRing == nullptr) {
+                ESP_LOGE(TAG, "No memory for %lu records", size);
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        // Swap the ring under the lock, free the old one outside of it
+        portENTER_CRITICAL(&captureMux);
+        if (newRing != nullptr) {
+            oldRing = captureRing;
+            captureRing = newRing;
+            captureSize = size;
+            captureHead = 0;
+            captureCount = 0;
+        }
+        captureActive = true;
+        portEXIT_CRITICAL(&captureMux);
+        free(oldRing);
+        ESP_LOGI(TAG, "Capture started, %lu records", captureSize);
+    } else if (argc >= 1 && strcmp(argv[0], "stop") == 0) {
+        portENTER_CRITICAL(&captureMux);
+        captureActive = false;
+        portEXIT_CRITICAL(&captureMux);
+        ESP_LOGI(TAG, "Capture stopped, %lu records", captureCount);
+    } else if (argc >= 1 && strcmp(argv[0], "clear") == 0) {
+        portENTER_CRITICAL(&captureMux);
+        captureHead = 0;
+        captureCount = 0;
+        portEXIT_CRITICAL(&captureMux);
+    } else if (argc >= 1 && strcmp(argv[0], "dump") == 0) {
+        if (captureRing == nullptr) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        app_capture_dump();
+    } else {
+        printf("light capture start [records] | stop | clear | dump\n");
+        printf("Capture %s, %lu of %lu records\n", captureActive.load() ? "active" : "stopped", captureCount, captureSize);
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,55 @@
+/*
+    Light shell commands
+*/
+
+#include <stdio.h>
+
+#include <esp_matter.h>
+#include <esp_matter_console.h>
+#include <app_priv.h>
+
+#if CONFIG_ENABLE_CHIP_SHELL
+using namespace esp_matter::console;
+
+static engine light_console;
+
+static esp_err_t light_console_help(const command_t *command, void *arg)
+{
+    printf("\t%-20s %s\n", command->name, command->description);
+    return ESP_OK;
+}
+
+static esp_err_t light_console_dispatch(int argc, char **argv)
+{
+    if (argc <= 0) {
+        light_console.for_each_command(light_console_help, nullptr);
+        return ESP_OK;
+    }
+    return light_console.exec_command(argc, argv);
+}
+
+void app_console_register_commands()
+{
+    static const command_t command = {
+        .name = "light",
+        .description = "Light commands. Usage: matter esp light <command>.",
+        .handler = light_console_dispatch,
+    };
+    static const command_t light_commands[] = {
+        {
+            .name = "capture",
+            .description = "Attribute update capture. Usage: matter esp light capture start [records] | stop | clear | dump",
+            .handler = app_capture_command,
+        },
+#if CONFIG_LIGHT_BENCH
+        {
+            .name = "bench",
+            .description = "Light pipeline benchmark. Usage: matter esp light bench sweep [rate/s] [seconds] | nvs [iterations] | log [iterations]",
+            .handler = app_light_bench_command,
+        },
+#endif
+    };
+    light_console.register_commands(light_commands, sizeof(light_commands) / sizeof(command_t));
+    add_commands(&command, 1);
+}
+#endif // CONFIG_ENABLE_CHIP_SHELL
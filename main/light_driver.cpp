@@ -5,12 +5,15 @@
 #include <esp_log.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 #include <esp_matter.h>
 #include <common_macros.h>
 #include <app_priv.h>
+#include <esp_timer.h>
 #include "driver/ledc.h"
 #include "soc/ledc_reg.h"
+#include "soc/soc_caps.h"
 
 static void fadeTask( void *pvParameters );
 
@@ -27,7 +30,21 @@ static uint16_t currentColorTemperature;
 static bool currentPowerState;
 static uint32_t currentPWM[2];
 
+// Button dimming in progress
+static bool dimActive;
+static uint8_t dimStartBrightness;
+static uint8_t dimTargetBrightness;
+static int64_t dimStartTime;
+static uint32_t dimTime;
+#if !SOC_LEDC_SUPPORT_FADE_STOP
+// No fade stop (ESP32): a long hardware fade can't be stopped, dim in short steps
+#define DIM_STEP_MS 50
+static esp_timer_handle_t dimStepTimer;
+#endif
+
 static QueueHandle_t fadeEventQueue;
+// Driver state is changed from Matter and button contexts
+static SemaphoreHandle_t driverMutex;
 
 static ledc_timer_config_t ledc_timer = {
     .speed_mode = LEDC_LOW_SPEED_MODE,        // timer mode
@@ -57,12 +74,15 @@ static ledc_channel_config_t ledcChannel[2] = {
 };
 
 void fadeTask( void *pvParameters ) {
-    uint32_t pwm[3];
+    // pwm[0..1] channel duty, pwm[2] fade time, pwm[3] time stamp, pwm[4] local control flag,
+    // pwm[5] replaced fades count
+    uint32_t pwm[6];
     int fadeTime;
 
     ESP_LOGI(TAG, "Init fade task chan");
     for( ;; ) {
         if (xQueueReceive(fadeEventQueue, &pwm, portMAX_DELAY)) {
+            uint32_t coalesced = pwm[5];
             fadeTime = pwm[2];
             for(int chan = 0; chan < 2; chan++) {
                 // const int duty = CIEL_10_12[fade->target];
@@ -70,19 +90,18 @@ void fadeTask( void *pvParameters ) {
                 ledc_set_fade_with_time(ledcChannel[chan].speed_mode, ledcChannel[chan].channel, duty, fadeTime);
             }
             ledc_fade_start(ledcChannel[0].speed_mode, ledcChannel[0].channel, LEDC_FADE_NO_WAIT);
+            uint32_t latency = (uint32_t)esp_timer_get_time() - pwm[3];
+            if (pwm[4]) {
+                ESP_LOGI(TAG, "Press to light latency: %lu us", latency);
+            }
+            app_stats_fade(latency, fadeTime, coalesced);
             ledc_fade_start(ledcChannel[1].speed_mode, ledcChannel[1].channel, LEDC_FADE_WAIT_DONE);
         }
     }
 }
 
-// Set PWM
-static void app_driver_light_set_pwm(uint8_t brightness, int16_t temperature) {
-    currentBrighness = brightness;
-    currentColorTemperature = temperature;
-
-    if (!currentPowerState) {
-        return;
-    }
+// Calculate channels duty
+static void app_driver_light_calc_pwm(uint8_t brightness, uint16_t temperature, uint32_t *pwm) {
     float tempCoeff = float(temperature - MiredsCool) / float(MiredsWarm - MiredsCool) * 2;
     float brightnessCoeff = float(brightness) / float(MATTER_BRIGHTNESS);
     float warmCoeff = tempCoeff * brightnessCoeff;
@@ -95,9 +114,34 @@ static void app_driver_light_set_pwm(uint8_t brightness, int16_t temperature) {
     }
     
     uint32_t dutyMax = 1 << ledc_timer.duty_resolution;
-    uint32_t pwm[3];
     pwm[0] = warmCoeff * dutyMax;
     pwm[1] = coldCoeff * dutyMax;
+
+    ESP_LOGI(TAG, "tempCoeff: %f, brCoeff: %f, max duty: %ld", tempCoeff, brightnessCoeff, dutyMax);
+    ESP_LOGI(TAG, "warmCoeff: %f, coldCoeff: %f", warmCoeff, coldCoeff);
+}
+
+// Send fade to the fade task, called with driverMutex taken
+static void app_driver_light_send_fade(uint32_t *pwm, uint32_t stamp) {
+    pwm[3] = stamp != 0 ? stamp : (uint32_t)esp_timer_get_time();
+    pwm[4] = stamp != 0;
+    pwm[5] = 0;
+    // One fade mailbox: only the latest target matters, a pending fade is replaced, never the newest one lost
+    uint32_t pending[6];
+    if (xQueueReceive(fadeEventQueue, pending, 0)) {
+        pwm[2] = std::max(pwm[2], pending[2]);
+        pwm[4] |= pending[4];
+        pwm[5] = pending[5] + 1;
+    }
+    if (xQueueOverwrite(fadeEventQueue, pwm) != pdTRUE) {
+        app_stats_fade_dropped();
+    }
+}
+
+// Start fade to new PWM, fade time is proportional to duty change
+static void app_driver_light_fade_pwm(uint8_t brightness, uint16_t temperature, uint32_t stamp) {
+    uint32_t pwm[6];
+    app_driver_light_calc_pwm(brightness, temperature, pwm);
     uint32_t fadeTime = 0;
     for(int chan = 0; chan < 2; chan++) {
         uint32_t time = 0;
@@ -113,11 +157,18 @@ static void app_driver_light_set_pwm(uint8_t brightness, int16_t temperature) {
         }
     }
     pwm[2] = fadeTime;
+    app_driver_light_send_fade(pwm, stamp);
+}
 
-    ESP_LOGI(TAG, "tempCoeff: %f, brCoeff: %f, max duty: %ld", tempCoeff, brightnessCoeff, dutyMax);
-    ESP_LOGI(TAG, "warmCoeff: %f, coldCoeff: %f", warmCoeff, coldCoeff);
-    
-    xQueueSend(fadeEventQueue, pwm, 0);
+// Set PWM
+static void app_driver_light_set_pwm(uint8_t brightness, int16_t temperature) {
+    currentBrighness = brightness;
+    currentColorTemperature = temperature;
+
+    if (!currentPowerState || dimActive) {
+        return;
+    }
+    app_driver_light_fade_pwm(brightness, temperature, 0);
 }
 
 static void app_driver_light_set_power(bool power)
@@ -126,9 +177,9 @@ static void app_driver_light_set_power(bool power)
     if (power) {
         // Power on
         // app_driver_light_set_pwm(0, currentColorTemperature);
-    } else {
-        // Power off
-        app_driver_light_set_pwm(0, currentColorTemperature);
+    } else if (currentPowerState) {
+        // Power off, keep current brightness
+        app_driver_light_fade_pwm(0, currentColorTemperature, 0);
     }
     currentPowerState = power;
 }
@@ -151,23 +202,136 @@ void app_driver_attribute_update(uint32_t cluster_id,
                                       uint32_t attribute_id, 
                                       esp_matter_attr_val_t *val)
 {
+    xSemaphoreTake(driverMutex, portMAX_DELAY);
     switch (cluster_id) {
     case OnOff::Id:
         if (attribute_id == OnOff::Attributes::OnOff::Id) {
+            app_stats_attribute_update();
             app_driver_light_set_power(val->val.b);
         }
         break;
     case LevelControl::Id:
         if (attribute_id == LevelControl::Attributes::CurrentLevel::Id) {
+            app_stats_attribute_update();
             app_driver_light_set_brightness(val->val.u8);
         }
         break;
     case ColorControl::Id:
         if (attribute_id == ColorControl::Attributes::ColorTemperatureMireds::Id) {
+            app_stats_attribute_update();
             app_driver_light_set_temperature(val->val.u16);
         }
         break;
     }
+    xSemaphoreGive(driverMutex);
+}
+
+void app_driver_light_local_set_power(bool power, uint32_t stamp)
+{
+    xSemaphoreTake(driverMutex, portMAX_DELAY);
+    ESP_LOGI(TAG, "LED local set power: %d", power);
+    if (power != currentPowerState) {
+        app_driver_light_fade_pwm(power ? currentBrighness : 0, currentColorTemperature, stamp);
+        currentPowerState = power;
+    }
+    xSemaphoreGive(driverMutex);
+}
+
+void app_driver_light_local_set_temperature(uint16_t mireds)
+{
+    xSemaphoreTake(driverMutex, portMAX_DELAY);
+    app_driver_light_set_temperature(mireds);
+    xSemaphoreGive(driverMutex);
+}
+
+// Dimming level reached now
+static uint8_t app_driver_light_dim_level()
+{
+    uint32_t elapsed = (esp_timer_get_time() - dimStartTime) / 1000;
+    if (elapsed >= dimTime) {
+        return dimTargetBrightness;
+    }
+    return dimStartBrightness + (dimTargetBrightness - dimStartBrightness) * int32_t(elapsed) / int32_t(dimTime);
+}
+
+#if !SOC_LEDC_SUPPORT_FADE_STOP
+static void app_driver_light_dim_step(void *arg)
+{
+    xSemaphoreTake(driverMutex, portMAX_DELAY);
+    if (dimActive) {
+        uint8_t brightness = app_driver_light_dim_level();
+        if (brightness != currentBrighness) {
+            currentBrighness = brightness;
+            app_driver_light_fade_pwm(brightness, currentColorTemperature, 0);
+        }
+    }
+    xSemaphoreGive(driverMutex);
+}
+#endif
+
+void app_driver_light_dim_start(bool up, uint32_t time_ms)
+{
+    xSemaphoreTake(driverMutex, portMAX_DELAY);
+    if (!currentPowerState || dimActive) {
+        xSemaphoreGive(driverMutex);
+        return;
+    }
+    dimStartBrightness = currentBrighness;
+    dimTargetBrightness = up ? MATTER_BRIGHTNESS : 1;
+    // Same dimming speed for any start level
+    dimTime = time_ms * abs(dimTargetBrightness - dimStartBrightness) / (MATTER_BRIGHTNESS - 1);
+    dimStartTime = esp_timer_get_time();
+    ESP_LOGI(TAG, "LED dim %s from %d, %lu ms", up ? "up" : "down", dimStartBrightness, dimTime);
+
+#if SOC_LEDC_SUPPORT_FADE_STOP
+    uint32_t pwm[6];
+    app_driver_light_calc_pwm(dimTargetBrightness, currentColorTemperature, pwm);
+    pwm[2] = dimTime;
+    currentPWM[0] = pwm[0];
+    currentPWM[1] = pwm[1];
+    app_driver_light_send_fade(pwm, 0);
+#else
+    esp_timer_start_periodic(dimStepTimer, DIM_STEP_MS * 1000);
+#endif
+    dimActive = true;
+    xSemaphoreGive(driverMutex);
+}
+
+void app_driver_light_dim_stop()
+{
+    xSemaphoreTake(driverMutex, portMAX_DELAY);
+    if (!dimActive) {
+        xSemaphoreGive(driverMutex);
+        return;
+    }
+    dimActive = false;
+    uint8_t brightness = app_driver_light_dim_level();
+    ESP_LOGI(TAG, "LED dim stop at %d", brightness);
+#if SOC_LEDC_SUPPORT_FADE_STOP
+    // Stop hardware fade and continue from the actual duty
+    for(int chan = 0; chan < 2; chan++) {
+        ledc_fade_stop(ledcChannel[chan].speed_mode, ledcChannel[chan].channel);
+        currentPWM[chan] = ledc_get_duty(ledcChannel[chan].speed_mode, ledcChannel[chan].channel);
+    }
+#else
+    esp_timer_stop(dimStepTimer);
+#endif
+    app_driver_light_set_pwm(brightness, currentColorTemperature);
+    xSemaphoreGive(driverMutex);
+}
+
+uint32_t app_driver_light_fade_backlog()
+{
+    return uxQueueMessagesWaiting(fadeEventQueue);
+}
+
+void app_driver_light_get_state(bool *power, uint8_t *brightness, uint16_t *mireds)
+{
+    xSemaphoreTake(driverMutex, portMAX_DELAY);
+    *power = currentPowerState;
+    *brightness = currentBrighness;
+    *mireds = currentColorTemperature;
+    xSemaphoreGive(driverMutex);
 }
 
 void app_driver_light_set_defaults(uint16_t endpoint_id)
@@ -191,7 +355,7 @@ void app_driver_light_set_defaults(uint16_t endpoint_id)
         MiredsCool = val.val.u16;
         attribute = attribute::get(endpoint_id, ColorControl::Id, ColorControl::Attributes::ColorTemperatureMireds::Id);
         attribute::get_val(attribute, &val);
-        app_driver_light_set_temperature(val.val.u16);
+        app_driver_light_local_set_temperature(val.val.u16);
         break;
     default:
         ESP_LOGE(TAG, "Color mode not supported");
@@ -201,25 +365,33 @@ void app_driver_light_set_defaults(uint16_t endpoint_id)
     /* Setting power */
     attribute = attribute::get(endpoint_id, OnOff::Id, OnOff::Attributes::OnOff::Id);
     attribute::get_val(attribute, &val);
-    app_driver_light_set_power(val.val.b);
+    app_driver_attribute_update(OnOff::Id, OnOff::Attributes::OnOff::Id, &val);
 
     /* Setting brightness */
     attribute = attribute::get(endpoint_id, LevelControl::Id, LevelControl::Attributes::CurrentLevel::Id);
     attribute::get_val(attribute, &val);
-    app_driver_light_set_brightness(val.val.u8);
+    app_driver_attribute_update(LevelControl::Id, LevelControl::Attributes::CurrentLevel::Id, &val);
 }
 
 void app_driver_light_init()
 {
     ledc_timer_config(&ledc_timer);
     
-    fadeEventQueue = xQueueCreate(10, sizeof(int32_t)*3);
+    fadeEventQueue = xQueueCreate(1, sizeof(int32_t)*6);
+    driverMutex = xSemaphoreCreateMutex();
     
     for(int chan = 0; chan < 2; chan++) {
         ledc_channel_config(&ledcChannel[chan]);
     }
 
     xTaskCreate(fadeTask, "fadeTask", 2048, nullptr, 15, nullptr);
+#if !SOC_LEDC_SUPPORT_FADE_STOP
+    const esp_timer_create_args_t dim_timer_args = {
+        .callback = app_driver_light_dim_step,
+        .name = "dim_step",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&dim_timer_args, &dimStepTimer));
+#endif
     
     ledc_fade_func_install(0);
 }
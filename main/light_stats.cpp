@@ -0,0 +1,177 @@
+/*
+    Light driver performance counters
+    Manufacturer-specific cluster on the light endpoint
+*/
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <nvs.h>
+#include <atomic>
+
+#include <esp_matter.h>
+#include <common_macros.h>
+#include <app_priv.h>
+
+using namespace esp_matter;
+
+static const char *TAG = "light_stats";
+
+#define STATS_HISTOGRAM_BINS 8
+
+typedef std::atomic<uint32_t> counter_t;
+
+static counter_t attributeUpdates;
+static counter_t fadesStarted;
+static counter_t fadesCoalesced;
+static counter_t fadesDropped;
+static counter_t nvsCommits;
+static counter_t logMessages;
+// Bin n: value < base << n, last bin: all above
+static counter_t latencyHistogram[STATS_HISTOGRAM_BINS];     // base 250 us
+static counter_t fadeTimeHistogram[STATS_HISTOGRAM_BINS];    // base 25 ms
+
+static uint16_t stats_endpoint_id;
+static uint32_t lastAttributeUpdates;
+
+static void stats_histogram_add(counter_t *histogram, uint32_t value, uint32_t base)
+{
+    int bin = 0;
+    while (bin < STATS_HISTOGRAM_BINS - 1 && value >= base << bin) {
+        bin++;
+    }
+    histogram[bin].fetch_add(1, std::memory_order_relaxed);
+}
+
+void app_stats_attribute_update()
+{
+    attributeUpdates.fetch_add(1, std::memory_order_relaxed);
+}
+
+void app_stats_fade(uint32_t latency_us, uint32_t fade_time_ms, uint32_t coalesced)
+{
+    fadesStarted.fetch_add(1, std::memory_order_relaxed);
+    if (coalesced) {
+        fadesCoalesced.fetch_add(coalesced, std::memory_order_relaxed);
+    }
+    stats_histogram_add(latencyHistogram, latency_us, 250);
+    stats_histogram_add(fadeTimeHistogram, fade_time_ms, 25);
+}
+
+void app_stats_fade_dropped()
+{
+    fadesDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void app_stats_log_message()
+{
+    logMessages.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t app_stats_get(uint32_t attribute_id)
+{
+    switch (attribute_id) {
+    case LIGHT_STATS_ATTRIBUTE_UPDATES:
+        return attributeUpdates.load(std::memory_order_relaxed);
+    case LIGHT_STATS_FADES_STARTED:
+        return fadesStarted.load(std::memory_order_relaxed);
+    case LIGHT_STATS_FADES_COALESCED:
+        return fadesCoalesced.load(std::memory_order_relaxed);
+    case LIGHT_STATS_FADES_DROPPED:
+        return fadesDropped.load(std::memory_order_relaxed);
+    case LIGHT_STATS_NVS_COMMITS:
+        return nvsCommits.load(std::memory_order_relaxed);
+    case LIGHT_STATS_LOG_MESSAGES:
+        return logMessages.load(std::memory_order_relaxed);
+    default:
+        return 0;
+    }
+}
+
+// Count commits of all NVS users, linked with --wrap=nvs_commit
+extern "C" esp_err_t __real_nvs_commit(nvs_handle_t handle);
+extern "C" esp_err_t __wrap_nvs_commit(nvs_handle_t handle)
+{
+    nvsCommits.fetch_add(1, std::memory_order_relaxed);
+    return __real_nvs_commit(handle);
+}
+
+static void stats_update(uint32_t attribute_id, uint32_t value)
+{
+    esp_matter_attr_val_t val = esp_matter_uint32(value);
+    attribute::update(stats_endpoint_id, LIGHT_STATS_CLUSTER_ID, attribute_id, &val);
+}
+
+static void stats_update_histogram(uint32_t attribute_id, counter_t *histogram)
+{
+    uint8_t data[STATS_HISTOGRAM_BINS * sizeof(uint32_t)];
+    for (int bin = 0; bin < STATS_HISTOGRAM_BINS; bin++) {
+        uint32_t count = histogram[bin].load(std::memory_order_relaxed);
+        for (int i = 0; i < 4; i++) {
+            data[bin * 4 + i] = count >> (i * 8);
+        }
+    }
+    esp_matter_attr_val_t val = esp_matter_octet_str(data, sizeof(data));
+    attribute::update(stats_endpoint_id, LIGHT_STATS_CLUSTER_ID, attribute_id, &val);
+}
+
+// Runs in the Matter thread
+static void stats_publish(intptr_t arg)
+{
+    uint32_t updates = attributeUpdates.load(std::memory_order_relaxed);
+    esp_matter_attr_val_t val = esp_matter_uint16((updates - lastAttributeUpdates) / CONFIG_LIGHT_STATS_PERIOD);
+    attribute::update(stats_endpoint_id, LIGHT_STATS_CLUSTER_ID, LIGHT_STATS_UPDATES_PER_SECOND, &val);
+    lastAttributeUpdates = updates;
+
+    stats_update(LIGHT_STATS_UPTIME, esp_timer_get_time() / 1000000);
+    stats_update(LIGHT_STATS_ATTRIBUTE_UPDATES, updates);
+    stats_update(LIGHT_STATS_FADES_STARTED, fadesStarted.load(std::memory_order_relaxed));
+    stats_update(LIGHT_STATS_FADES_COALESCED, fadesCoalesced.load(std::memory_order_relaxed));
+    stats_update(LIGHT_STATS_FADES_DROPPED, fadesDropped.load(std::memory_order_relaxed));
+    stats_update(LIGHT_STATS_NVS_COMMITS, nvsCommits.load(std::memory_order_relaxed));
+    stats_update(LIGHT_STATS_LOG_MESSAGES, logMessages.load(std::memory_order_relaxed));
+    stats_update_histogram(LIGHT_STATS_LATENCY_HISTOGRAM, latencyHistogram);
+    stats_update_histogram(LIGHT_STATS_FADE_TIME_HISTOGRAM, fadeTimeHistogram);
+}
+
+static void stats_timer_cb(void *arg)
+{
+    chip::DeviceLayer::PlatformMgr().ScheduleWork(stats_publish);
+}
+
+void app_stats_create_cluster(endpoint_t *endpoint)
+{
+    cluster_t *cluster = cluster::create(endpoint, LIGHT_STATS_CLUSTER_ID, CLUSTER_FLAG_SERVER);
+    ABORT_APP_ON_FAILURE(cluster != nullptr, ESP_LOGE(TAG, "Failed to create stats cluster"));
+    stats_endpoint_id = endpoint::get_id(endpoint);
+
+    cluster::global::attribute::create_cluster_revision(cluster, 1);
+    cluster::global::attribute::create_feature_map(cluster, 0);
+
+    const uint32_t counters[] = {
+        LIGHT_STATS_UPTIME,
+        LIGHT_STATS_ATTRIBUTE_UPDATES,
+        LIGHT_STATS_FADES_STARTED,
+        LIGHT_STATS_FADES_COALESCED,
+        LIGHT_STATS_FADES_DROPPED,
+        LIGHT_STATS_NVS_COMMITS,
+        LIGHT_STATS_LOG_MESSAGES,
+    };
+    for (auto attribute_id : counters) {
+        attribute::create(cluster, attribute_id, ATTRIBUTE_FLAG_NONE, esp_matter_uint32(0));
+    }
+    attribute::create(cluster, LIGHT_STATS_UPDATES_PER_SECOND, ATTRIBUTE_FLAG_NONE, esp_matter_uint16(0));
+
+    uint8_t histogram[STATS_HISTOGRAM_BINS * sizeof(uint32_t)] = {};
+    attribute::create(cluster, LIGHT_STATS_LATENCY_HISTOGRAM, ATTRIBUTE_FLAG_NONE,
+                      esp_matter_octet_str(histogram, sizeof(histogram)), sizeof(histogram));
+    attribute::create(cluster, LIGHT_STATS_FADE_TIME_HISTOGRAM, ATTRIBUTE_FLAG_NONE,
+                      esp_matter_octet_str(histogram, sizeof(histogram)), sizeof(histogram));
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = stats_timer_cb,
+        .name = "light_stats",
+    };
+    esp_timer_handle_t timer;
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(timer, CONFIG_LIGHT_STATS_PERIOD * 1000000ULL));
+}
@@ -0,0 +1,155 @@
+/*
+    Power cycle gesture counter
+    Full power off: boots since the last stable boot, from the Matter reboot counter
+    (already written to NVS at every boot) and the reboot count of the last stable boot,
+    written once when the power is stable, or at once after any other reset reason.
+    Brown-out: counter in RTC memory, no NVS writes.
+    Only the on time is checked, off time between the cycles is not limited.
+*/
+
+#include <esp_log.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <nvs.h>
+
+#include <esp_matter.h>
+#include <app_priv.h>
+#include <app/server/Server.h>
+
+static const char *TAG = "power_cycle";
+
+#define POWER_CYCLE_MAGIC 0x50574359
+
+typedef struct {
+    uint32_t magic;
+    uint32_t count;
+    uint32_t check;
+} power_cycle_t;
+
+// Survives resets, lost on full power off
+RTC_NOINIT_ATTR static power_cycle_t s_power_cycle;
+
+static uint32_t power_cycle_count = 0;
+static bool power_cycle_cold = false;
+
+#if CONFIG_POWER_CYCLE_NVS
+static const char *nvs_namespace = "power_cycle";
+static const char *nvs_key = "stable_boot";
+static uint32_t reboot_count = 0;
+
+// Quick power cycles since the last stable boot
+static uint32_t power_cycle_nvs_count()
+{
+    nvs_handle_t handle;
+    uint32_t stable_boot = 0;
+    if (nvs_open(nvs_namespace, NVS_READONLY, &handle) == ESP_OK) {
+        nvs_get_u32(handle, nvs_key, &stable_boot);
+        nvs_close(handle);
+    }
+    return stable_boot != 0 && reboot_count > stable_boot ? reboot_count - stable_boot : 1;
+}
+
+// The only NVS write, once per boot
+static void power_cycle_nvs_stable()
+{
+    nvs_handle_t handle;
+    if (nvs_open(nvs_namespace, NVS_READWRITE, &handle) == ESP_OK) {
+        nvs_set_u32(handle, nvs_key, reboot_count);
+        nvs_commit(handle);
+        nvs_close(handle);
+    }
+}
+#endif
+
+static void power_cycle_store(uint32_t count)
+{
+    s_power_cycle.magic = POWER_CYCLE_MAGIC;
+    s_power_cycle.count = count;
+    s_power_cycle.check = ~count;
+}
+
+static void power_cycle_stable_cb(void *arg)
+{
+    ESP_LOGI(TAG, "Power stable, clear counter");
+    power_cycle_store(0);
+#if CONFIG_POWER_CYCLE_NVS
+    if (reboot_count != 0) {
+        power_cycle_nvs_stable();
+    }
+#endif
+}
+
+static void power_cycle_action(intptr_t arg)
+{
+#if CONFIG_POWER_CYCLE_FACTORY_RESET
+    ESP_LOGI(TAG, "Starting factory reset");
+    esp_matter::factory_reset();
+#else
+    chip::CommissioningWindowManager & commissionMgr = chip::Server::GetInstance().GetCommissioningWindowManager();
+    if (!commissionMgr.IsCommissioningWindowOpen()) {
+        ESP_LOGI(TAG, "Open commissioning window");
+        chip::DeviceLayer::ConnectivityMgr().SetBLEAdvertisingEnabled(true);
+        CHIP_ERROR err = commissionMgr.OpenBasicCommissioningWindow(chip::System::Clock::Seconds16(CONFIG_POWER_CYCLE_WINDOW_TIMEOUT));
+        if (err != CHIP_NO_ERROR) {
+            ESP_LOGE(TAG, "Failed to open commissioning window: %" CHIP_ERROR_FORMAT, err.Format());
+        }
+    }
+#endif
+}
+
+void app_power_cycle_init()
+{
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT) {
+        // Software restart, watchdog, etc.
+        power_cycle_store(0);
+        return;
+    }
+
+    if (s_power_cycle.magic == POWER_CYCLE_MAGIC && s_power_cycle.check == ~s_power_cycle.count) {
+        // RTC memory retained over brown-out
+        power_cycle_count = s_power_cycle.count + 1;
+    } else {
+        // Full power off, counted from NVS after Matter start
+        power_cycle_cold = true;
+        power_cycle_count = 1;
+    }
+    power_cycle_store(power_cycle_count);
+}
+
+void app_power_cycle_process()
+{
+#if CONFIG_POWER_CYCLE_NVS
+    // Matter increments the reboot counter at start, on every boot
+    if (chip::DeviceLayer::ConfigurationMgr().GetRebootCount(reboot_count) != CHIP_NO_ERROR) {
+        ESP_LOGE(TAG, "No reboot count");
+        reboot_count = 0;
+    } else if (power_cycle_count == 0) {
+        // Restart, panic, watchdog: not a power cycle, the next power on starts a new sequence
+        power_cycle_nvs_stable();
+    } else if (power_cycle_cold) {
+        power_cycle_count = power_cycle_nvs_count();
+        power_cycle_store(power_cycle_count);
+    }
+#endif
+    ESP_LOGI(TAG, "Power cycle count: %lu", power_cycle_count);
+    if (power_cycle_count >= CONFIG_POWER_CYCLE_COUNT) {
+        ESP_LOGI(TAG, "%lu quick power cycles", power_cycle_count);
+        power_cycle_stable_cb(nullptr);
+        chip::DeviceLayer::PlatformMgr().ScheduleWork(power_cycle_action);
+        return;
+    }
+    if (power_cycle_count == 0) {
+        return;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = power_cycle_stable_cb,
+        .name = "power_cycle",
+    };
+    esp_timer_handle_t timer;
+    if (esp_timer_create(&timer_args, &timer) == ESP_OK) {
+        esp_timer_start_once(timer, CONFIG_POWER_CYCLE_STABLE_TIME * 1000);
+    }
+}
@@ -0,0 +1,79 @@
+#!/bin/bash
+# Make compressed delta OTA image: makeDeltaOTA.sh <base.bin> <new.bin> <version> <version string>
+# Base image must be the firmware currently running on the devices (ota_0 or ota_1).
+if [[ $# != 4 ]]; then
+    echo "Usage: $0 <base.bin> <new.bin> <version> <version string>"
+    exit 1
+fi
+base_binary=$1
+new_binary=$2
+version=$3
+version_str=$4
+
+source ./factory.sh
+MATTER_SDK_PATH=$ESP_MATTER_PATH/connectedhomeip/connectedhomeip
+outdir=ota_images
+mkdir -p $outdir
+patch_file=$outdir/$PRODUCT_NAME-$version_str.patch
+ota_file=$outdir/$PRODUCT_NAME-$version_str-delta.ota
+
+patch_gen=${DELTA_OTA_PATCH_GEN:-$(find ./managed_components -name esp_delta_ota_patch_gen.py -print -quit 2>/dev/null)}
+if [[ ${#patch_gen} == 0 ]]; then
+    echo esp_delta_ota_patch_gen.py not found. Run idf.py reconfigure or set DELTA_OTA_PATCH_GEN.
+    exit 1
+fi
+
+echo Make delta patch
+python "$patch_gen" create_patch \
+    --chip "$IDF_TARGET" \
+    --base_binary "$base_binary" \
+    --new_binary "$new_binary" \
+    --patch_file_name "$patch_file" || exit 1
+
+# Round-trip check with Python detools (same patch format, not the device C decoder),
+# tools/delta_ota_test runs the esp_delta_ota C decoder on host
+echo Verify delta patch
+python - "$base_binary" "$new_binary" "$patch_file" <<'EOF' || exit 1
+import io, struct, sys
+import detools
+
+PATCH_HEADER_SIZE = 64
+PATCH_MAGIC = 0xfccdde10
+
+base, new, patch = sys.argv[1:4]
+with open(patch, 'rb') as f:
+    header = f.read(PATCH_HEADER_SIZE)
+    if struct.unpack('<I', header[:4])[0] != PATCH_MAGIC:
+        sys.exit('Bad patch magic')
+    patched = io.BytesIO()
+    with open(base, 'rb') as fbase:
+        detools.apply_patch(fbase, f, patched)
+with open(new, 'rb') as fnew:
+    if patched.getvalue() != fnew.read():
+        sys.exit('Patched image differs from ' + new)
+print('Patch OK')
+EOF
+
+# Encrypted OTA: device decrypts the stream first, then feeds the patch decoder
+if grep -q "^CONFIG_ENABLE_ENCRYPTED_OTA=y" sdkconfig 2>/dev/null; then
+    enc_gen=$(find ./managed_components -name esp_enc_img_gen.py -print -quit 2>/dev/null)
+    if [[ ${#enc_gen} == 0 ]]; then
+        echo esp_enc_img_gen.py not found
+        exit 1
+    fi
+    echo Encrypt delta patch
+    openssl rsa -in esp_image_encryption_key.pem -pubout -out $outdir/public_key.pem || exit 1
+    python "$enc_gen" encrypt "$patch_file" $outdir/public_key.pem "$patch_file.enc" || exit 1
+    patch_file=$patch_file.enc
+fi
+
+echo Make Matter OTA image
+python "$MATTER_SDK_PATH/src/app/ota_image_tool.py" create \
+    --vendor-id 0x$VENDOR_ID \
+    --product-id 0x$PRODUCT_ID \
+    --version $version \
+    --version-str "$version_str" \
+    --digest-algorithm sha256 \
+    "$patch_file" "$ota_file" || exit 1
+
+echo Full image: $(stat -c %s "$new_binary") bytes, delta OTA image: $(stat -c %s "$ota_file") bytes
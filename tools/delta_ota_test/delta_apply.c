@@ -0,0 +1,104 @@
+/*
+    Apply delta OTA patch on host the same way as esp_delta_ota on the device:
+    check the patch header against the base image hash, then feed the patch to the detools decoder in OTA blocks.
+    Usage: delta_apply <base.bin> <patch.bin> <out.bin> [block size]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "detools.h"
+
+#define PATCH_HEADER_SIZE 64
+#define PATCH_MAGIC 0xfccdde10
+#define IMAGE_HASH_SIZE 32
+
+typedef struct {
+    FILE *base;
+    FILE *out;
+} files_t;
+
+static int base_read(void *arg_p, uint8_t *buf_p, size_t size)
+{
+    files_t *files = (files_t *)arg_p;
+    return fread(buf_p, 1, size, files->base) == size ? 0 : -1;
+}
+
+static int base_seek(void *arg_p, int offset)
+{
+    files_t *files = (files_t *)arg_p;
+    return fseek(files->base, offset, SEEK_CUR);
+}
+
+static int out_write(void *arg_p, const uint8_t *buf_p, size_t size)
+{
+    files_t *files = (files_t *)arg_p;
+    return fwrite(buf_p, 1, size, files->out) == size ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s <base.bin> <patch.bin> <out.bin> [block size]\n", argv[0]);
+        return 1;
+    }
+    size_t block_size = argc >= 5 ? strtoul(argv[4], NULL, 0) : 1024;
+    if (block_size == 0) {
+        fprintf(stderr, "Bad block size\n");
+        return 1;
+    }
+
+    FILE *patch = fopen(argv[2], "rb");
+    files_t files = {fopen(argv[1], "rb"), fopen(argv[3], "wb")};
+    if (patch == NULL || files.base == NULL || files.out == NULL) {
+        perror("fopen");
+        return 1;
+    }
+    fseek(patch, 0, SEEK_END);
+    long patch_size = ftell(patch);
+    fseek(patch, 0, SEEK_SET);
+
+    uint8_t header[PATCH_HEADER_SIZE];
+    uint32_t magic;
+    if (patch_size < PATCH_HEADER_SIZE || fread(header, 1, sizeof(header), patch) != sizeof(header)) {
+        fprintf(stderr, "Short patch\n");
+        return 1;
+    }
+    memcpy(&magic, header, sizeof(magic));
+    if (magic != PATCH_MAGIC) {
+        fprintf(stderr, "Bad patch magic 0x%08x\n", magic);
+        return 1;
+    }
+    // Device compares it with the running app image hash, appended to the image
+    uint8_t image_hash[IMAGE_HASH_SIZE];
+    if (fseek(files.base, -IMAGE_HASH_SIZE, SEEK_END) != 0
+        || fread(image_hash, 1, sizeof(image_hash), files.base) != sizeof(image_hash)
+        || memcmp(image_hash, header + sizeof(magic), sizeof(image_hash)) != 0) {
+        fprintf(stderr, "Patch is not for this base image\n");
+        return 1;
+    }
+    fseek(files.base, 0, SEEK_SET);
+
+    struct detools_apply_patch_t apply_patch;
+    int res = detools_apply_patch_init(&apply_patch, base_read, base_seek,
+                                       patch_size - PATCH_HEADER_SIZE, out_write, &files);
+    uint8_t *block = malloc(block_size);
+    size_t size;
+    while (res == 0 && (size = fread(block, 1, block_size, patch)) > 0) {
+        res = detools_apply_patch_process(&apply_patch, block, size);
+    }
+    if (res == 0) {
+        res = detools_apply_patch_finalize(&apply_patch);
+    }
+    free(block);
+    fclose(patch);
+    fclose(files.base);
+    fclose(files.out);
+    if (res < 0) {
+        fprintf(stderr, "Patch failed: %s\n", detools_error_as_string(res));
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+# Delta OTA round-trip: make sample base/new images, make the patch, apply it with the C decoder
+# in OTA blocks and compare to the new image.
+# Without the generator the patch is made here in the esp_delta_ota format (heatshrink compressed
+# detools patch, header with the base image hash). With it, the patch of a changed firmware image
+# is made by esp_delta_ota_patch_gen.py, as in makeDeltaOTA.sh.
+# Usage: round_trip.py <delta_apply> <work dir> [<esp_delta_ota_patch_gen.py> <chip> <base image>]
+
+import hashlib
+import io
+import os
+import random
+import struct
+import subprocess
+import sys
+
+import detools
+
+PATCH_HEADER_SIZE = 64
+PATCH_MAGIC = 0xfccdde10
+
+
+def make_patch(base, new):
+    patch = io.BytesIO()
+    detools.create_patch(io.BytesIO(base), io.BytesIO(new), patch, compression='heatshrink')
+    # App image hash, appended to the image
+    header = struct.pack('<I', PATCH_MAGIC) + base[-32:]
+    return header.ljust(PATCH_HEADER_SIZE, b'\0') + patch.getvalue()
+
+
+def make_patch_gen(patch_gen, chip, paths):
+    subprocess.run([sys.executable, patch_gen, 'create_patch', '--chip', chip,
+                    '--base_binary', paths['base'], '--new_binary', paths['new'],
+                    '--patch_file_name', paths['patch']], check=True)
+
+
+def sample_images(rnd):
+    # Firmware-like image: repeated code patterns and random data
+    chunks = [bytes(rnd.randrange(256) for _ in range(rnd.randrange(16, 64))) for _ in range(64)]
+    base = b''.join(rnd.choice(chunks) for _ in range(8000))
+    base += hashlib.sha256(base).digest()
+    return base, changed_image(rnd, base)
+
+
+def changed_image(rnd, base):
+    new = bytearray(base)
+    for _ in range(20):
+        pos = rnd.randrange(len(new))
+        new[pos:pos] = bytes(rnd.randrange(256) for _ in range(rnd.randrange(1, 200)))
+    for _ in range(200):
+        new[rnd.randrange(len(new))] = rnd.randrange(256)
+    del new[1000:3000]
+    return bytes(new)
+
+
+def main():
+    delta_apply, work_dir = sys.argv[1:3]
+    patch_gen = sys.argv[3:6]
+    os.makedirs(work_dir, exist_ok=True)
+    rnd = random.Random(1)
+    if patch_gen:
+        with open(patch_gen[2], 'rb') as f:
+            base = f.read()
+        cases = [(base, changed_image(rnd, base)), (base, base)]
+    else:
+        small = b'small image' + bytes(32)
+        same = b'same image' * 1000 + bytes(32)
+        cases = [sample_images(rnd), (small, b'new image'), (same, same)]
+    for index, (base, new) in enumerate(cases):
+        paths = {name: os.path.join(work_dir, '%d_%s.bin' % (index, name)) for name in ('base', 'new', 'patch', 'out')}
+        for name, data in (('base', base), ('new', new)):
+            with open(paths[name], 'wb') as f:
+                f.write(data)
+        if patch_gen:
+            make_patch_gen(patch_gen[0], patch_gen[1], paths)
+        else:
+            with open(paths['patch'], 'wb') as f:
+                f.write(make_patch(base, new))
+        with open(paths['patch'], 'rb') as f:
+            patch = f.read()
+        for block_size in (1, 1024, 4096):
+            subprocess.run([delta_apply, paths['base'], paths['patch'], paths['out'], str(block_size)], check=True)
+            with open(paths['out'], 'rb') as f:
+                if f.read() != new:
+                    sys.exit('Case %d, block %d: patched image differs' % (index, block_size))
+        print('Case %d: %d -> %d bytes, patch %d bytes' % (index, len(base), len(new), len(patch)))
+
+
+if __name__ == '__main__':
+    main()
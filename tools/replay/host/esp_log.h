@@ -0,0 +1,20 @@
+/*
+    Host replay: ESP-IDF logging, printed with -v only
+*/
+
+#pragma once
+
+#include <stdio.h>
+
+extern bool host_log_enabled;
+
+#define HOST_LOG(level, tag, format, ...) do {                          \
+        if (host_log_enabled) {                                         \
+            printf(level " %s: " format "\n", tag, ##__VA_ARGS__);      \
+        }                                                               \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) HOST_LOG("I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) HOST_LOG("D", tag, format, ##__VA_ARGS__)
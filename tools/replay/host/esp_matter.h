@@ -0,0 +1,110 @@
+/*
+    Host replay: minimal esp_matter data model used by the light driver
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+
+#define REMAP_TO_RANGE(value, from, to) ((value * to) / from)
+#define REMAP_TO_RANGE_INVERSE(value, factor) (factor / (value ? value : 1))
+
+typedef enum {
+    ESP_MATTER_VAL_TYPE_INVALID = 0,
+    ESP_MATTER_VAL_TYPE_BOOLEAN = 1,
+    ESP_MATTER_VAL_TYPE_UINT8 = 10,
+    ESP_MATTER_VAL_TYPE_UINT16 = 12,
+} esp_matter_val_type_t;
+
+typedef union {
+    bool b;
+    int i;
+    float f;
+    int8_t i8;
+    uint8_t u8;
+    int16_t i16;
+    uint16_t u16;
+    int32_t i32;
+    uint32_t u32;
+    int64_t i64;
+    uint64_t u64;
+} esp_matter_val_t;
+
+typedef struct {
+    esp_matter_val_type_t type;
+    esp_matter_val_t val;
+} esp_matter_attr_val_t;
+
+esp_matter_attr_val_t esp_matter_invalid(void *val);
+
+namespace esp_matter {
+
+typedef struct host_attribute attribute_t;
+typedef struct host_endpoint endpoint_t;
+
+namespace attribute {
+
+typedef enum callback_type {
+    PRE_UPDATE,
+    POST_UPDATE,
+    READ,
+    WRITE,
+} callback_type_t;
+
+attribute_t *get(uint16_t endpoint_id, uint32_t cluster_id, uint32_t attribute_id);
+esp_err_t get_val(attribute_t *attribute, esp_matter_attr_val_t *val);
+
+} // namespace attribute
+} // namespace esp_matter
+
+namespace chip {
+namespace app {
+namespace Clusters {
+
+namespace OnOff {
+constexpr uint32_t Id = 0x0006;
+namespace Attributes {
+namespace OnOff {
+constexpr uint32_t Id = 0x0000;
+}
+} // namespace Attributes
+} // namespace OnOff
+
+namespace LevelControl {
+constexpr uint32_t Id = 0x0008;
+namespace Attributes {
+namespace CurrentLevel {
+constexpr uint32_t Id = 0x0000;
+}
+} // namespace Attributes
+} // namespace LevelControl
+
+namespace ColorControl {
+constexpr uint32_t Id = 0x0300;
+enum class ColorMode : uint8_t {
+    kCurrentHueAndCurrentSaturation = 0,
+    kCurrentXAndCurrentY = 1,
+    kColorTemperature = 2,
+};
+namespace Attributes {
+namespace ColorTemperatureMireds {
+constexpr uint32_t Id = 0x0007;
+}
+namespace ColorMode {
+constexpr uint32_t Id = 0x0008;
+}
+namespace ColorTempPhysicalMinMireds {
+constexpr uint32_t Id = 0x400B;
+}
+namespace ColorTempPhysicalMaxMireds {
+constexpr uint32_t Id = 0x400C;
+}
+} // namespace Attributes
+} // namespace ColorControl
+
+} // namespace Clusters
+} // namespace app
+} // namespace chip
@@ -0,0 +1,9 @@
+/*
+    Host replay: virtual time, us
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
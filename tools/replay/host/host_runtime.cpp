@@ -0,0 +1,347 @@
+/*
+    Host replay runtime: FreeRTOS, LEDC, esp_timer and data model stubs
+
+    The fade task runs in its own thread. Replay feeds the driver from the main
+    thread and waits until the fade task blocks before the next record, so the
+    PWM timeline is deterministic. In timed mode the clock is virtual and
+    LEDC_FADE_WAIT_DONE blocks until the virtual time reaches the fade end.
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string.h>
+#include <thread>
+
+#include <esp_timer.h>
+#include <driver/ledc.h>
+#include <freertos/FreeRTOS.h>
+#include "host_runtime.h"
+
+bool host_log_enabled = false;
+
+struct host_queue {
+    size_t item_size;
+    size_t length;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+struct host_semaphore {
+    std::mutex mutex;
+};
+
+typedef enum {
+    WORKER_RUNNING,
+    WORKER_RECEIVING,
+    WORKER_FADING,
+} worker_state_t;
+
+typedef struct {
+    uint32_t start_duty;
+    uint32_t target_duty;
+    int64_t start_time;
+    int64_t fade_time;
+    uint32_t next_duty;
+    int next_fade_time_ms;
+} channel_state_t;
+
+// Never destroyed: the fade task thread is blocked at exit
+static std::mutex &runtime_mutex = *new std::mutex;
+static std::condition_variable &runtime_cv = *new std::condition_variable;
+static std::vector<host_pwm_event_t> &pwm_timeline = *new std::vector<host_pwm_event_t>;
+static std::map<uint64_t, esp_matter_attr_val_t> &attributes = *new std::map<uint64_t, esp_matter_attr_val_t>;
+
+static bool timed_mode = true;
+static int64_t virtual_time = 0;
+static std::chrono::steady_clock::time_point start_time;
+
+static bool worker_started = false;
+static worker_state_t worker_state = WORKER_RUNNING;
+static host_queue *worker_queue;
+static int64_t worker_fade_end;
+
+static channel_state_t channels[LEDC_CHANNEL_MAX];
+
+void host_init(bool timed)
+{
+    timed_mode = timed;
+    start_time = std::chrono::steady_clock::now();
+}
+
+static int64_t host_now()
+{
+    if (timed_mode) {
+        return virtual_time;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+int64_t esp_timer_get_time()
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    return host_now();
+}
+
+// Call with runtime_mutex locked
+static bool worker_idle()
+{
+    if (!worker_started) {
+        return true;
+    }
+    switch (worker_state) {
+    case WORKER_RECEIVING:
+        return worker_queue->items.empty();
+    case WORKER_FADING:
+        return worker_fade_end > virtual_time;
+    default:
+        return false;
+    }
+}
+
+void host_wait_idle()
+{
+    std::unique_lock<std::mutex> lock(runtime_mutex);
+    runtime_cv.wait(lock, worker_idle);
+}
+
+void host_advance_to(int64_t time_us)
+{
+    std::unique_lock<std::mutex> lock(runtime_mutex);
+    for (;;) {
+        runtime_cv.wait(lock, worker_idle);
+        if (worker_started && worker_state == WORKER_FADING && worker_fade_end <= time_us) {
+            virtual_time = worker_fade_end;
+            runtime_cv.notify_all();
+            continue;
+        }
+        break;
+    }
+    if (time_us > virtual_time) {
+        virtual_time = time_us;
+    }
+}
+
+int64_t host_finish()
+{
+    std::unique_lock<std::mutex> lock(runtime_mutex);
+    for (;;) {
+        runtime_cv.wait(lock, worker_idle);
+        if (worker_started && worker_state == WORKER_FADING) {
+            virtual_time = worker_fade_end;
+            runtime_cv.notify_all();
+            continue;
+        }
+        return virtual_time;
+    }
+}
+
+const std::vector<host_pwm_event_t> &host_pwm_timeline()
+{
+    return pwm_timeline;
+}
+
+/* FreeRTOS */
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stack_depth, void *parameters,
+                       UBaseType_t priority, TaskHandle_t *created_task)
+{
+    {
+        std::lock_guard<std::mutex> lock(runtime_mutex);
+        worker_started = true;
+        worker_state = WORKER_RUNNING;
+    }
+    std::thread(task, parameters).detach();
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    host_queue *queue = new host_queue;
+    queue->item_size = item_size;
+    queue->length = length;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    if (queue->items.size() >= queue->length) {
+        return errQUEUE_FULL;
+    }
+    const uint8_t *data = (const uint8_t *)item;
+    queue->items.emplace_back(data, data + queue->item_size);
+    runtime_cv.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    const uint8_t *data = (const uint8_t *)item;
+    queue->items.clear();
+    queue->items.emplace_back(data, data + queue->item_size);
+    runtime_cv.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait)
+{
+    std::unique_lock<std::mutex> lock(runtime_mutex);
+    if (queue->items.empty()) {
+        if (ticks_to_wait == 0) {
+            return pdFALSE;
+        }
+        worker_queue = queue;
+        worker_state = WORKER_RECEIVING;
+        runtime_cv.notify_all();
+        runtime_cv.wait(lock, [queue] { return !queue->items.empty(); });
+        worker_state = WORKER_RUNNING;
+    }
+    memcpy(buffer, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    return queue->items.size();
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return new host_semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait)
+{
+    semaphore->mutex.lock();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    semaphore->mutex.unlock();
+    return pdTRUE;
+}
+
+/* LEDC */
+
+// Call with runtime_mutex locked
+static uint32_t channel_duty(const channel_state_t &state, int64_t now)
+{
+    int64_t elapsed = now - state.start_time;
+    if (state.fade_time <= 0 || elapsed >= state.fade_time) {
+        return state.target_duty;
+    }
+    int64_t delta = int64_t(state.target_duty) - int64_t(state.start_duty);
+    return state.start_duty + delta * elapsed / state.fade_time;
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timer_conf)
+{
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledc_conf)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    channels[ledc_conf->channel] = {};
+    channels[ledc_conf->channel].start_duty = ledc_conf->duty;
+    channels[ledc_conf->channel].target_duty = ledc_conf->duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags)
+{
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t target_duty, int max_fade_time_ms)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    channels[channel].next_duty = target_duty;
+    channels[channel].next_fade_time_ms = max_fade_time_ms;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t speed_mode, ledc_channel_t channel, ledc_fade_mode_t fade_mode)
+{
+    std::unique_lock<std::mutex> lock(runtime_mutex);
+    int64_t now = host_now();
+    channel_state_t &state = channels[channel];
+    state.start_duty = channel_duty(state, now);
+    state.target_duty = state.next_duty;
+    state.start_time = now;
+    state.fade_time = timed_mode ? int64_t(state.next_fade_time_ms) * 1000 : 0;
+    pwm_timeline.push_back({now, channel, state.start_duty, state.target_duty, state.next_fade_time_ms});
+
+    if (fade_mode == LEDC_FADE_WAIT_DONE && state.fade_time > 0) {
+        worker_fade_end = now + state.fade_time;
+        worker_state = WORKER_FADING;
+        runtime_cv.notify_all();
+        runtime_cv.wait(lock, [] { return virtual_time >= worker_fade_end; });
+        worker_state = WORKER_RUNNING;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_stop(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    int64_t now = host_now();
+    channel_state_t &state = channels[channel];
+    state.target_duty = channel_duty(state, now);
+    state.fade_time = 0;
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    return channel_duty(channels[channel], host_now());
+}
+
+/* Data model */
+
+esp_matter_attr_val_t esp_matter_invalid(void *val)
+{
+    esp_matter_attr_val_t attr_val = {};
+    attr_val.type = ESP_MATTER_VAL_TYPE_INVALID;
+    return attr_val;
+}
+
+void host_set_attribute(uint32_t cluster_id, uint32_t attribute_id, esp_matter_attr_val_t val)
+{
+    attributes[(uint64_t)cluster_id << 32 | attribute_id] = val;
+}
+
+namespace esp_matter {
+namespace attribute {
+
+attribute_t *get(uint16_t endpoint_id, uint32_t cluster_id, uint32_t attribute_id)
+{
+    auto it = attributes.find((uint64_t)cluster_id << 32 | attribute_id);
+    if (it == attributes.end()) {
+        return nullptr;
+    }
+    return (attribute_t *)&it->second;
+}
+
+esp_err_t get_val(attribute_t *attribute, esp_matter_attr_val_t *val)
+{
+    if (attribute == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *val = *(esp_matter_attr_val_t *)attribute;
+    return ESP_OK;
+}
+
+} // namespace attribute
+} // namespace esp_matter
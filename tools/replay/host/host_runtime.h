@@ -0,0 +1,40 @@
+/*
+    Host replay runtime control
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <esp_matter.h>
+
+/** PWM timeline event: fade start on a channel */
+typedef struct {
+    int64_t time_us;
+    int channel;
+    uint32_t from_duty;
+    uint32_t to_duty;
+    int fade_time_ms;
+} host_pwm_event_t;
+
+/** Init runtime
+ *
+ * @param[in] timed Virtual time, fades take their time. Otherwise wall clock time and instant fades.
+ *
+ */
+void host_init(bool timed);
+
+/** Set data model attribute value returned by `attribute::get_val()` */
+void host_set_attribute(uint32_t cluster_id, uint32_t attribute_id, esp_matter_attr_val_t val);
+
+/** Wait until the fade task is blocked on the empty queue or on a fade in progress */
+void host_wait_idle();
+
+/** Advance virtual time, running fades which end before it */
+void host_advance_to(int64_t time_us);
+
+/** Run all queued fades to the end, returns virtual time after the last fade, us */
+int64_t host_finish();
+
+/** PWM timeline */
+const std::vector<host_pwm_event_t> &host_pwm_timeline();
@@ -0,0 +1,3 @@
+#pragma once
+
+#define SOC_LEDC_SUPPORT_FADE_STOP 1
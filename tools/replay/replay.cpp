@@ -0,0 +1,230 @@
+/*
+    Attribute update workload replay
+    Feeds `light capture dump` output to the light driver through app_driver_attribute_update()
+    and reports the PWM timeline, fade counts and throughput.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <esp_log.h>
+#include <esp_matter.h>
+#include <app_priv.h>
+#include "host_runtime.h"
+
+using namespace chip::app::Clusters;
+
+#define HISTOGRAM_BINS 8
+
+static std::atomic<uint32_t> attributeUpdates;
+static std::atomic<uint32_t> fadesStarted;
+static std::atomic<uint32_t> fadesCoalesced;
+static std::atomic<uint32_t> fadesDropped;
+static std::atomic<uint32_t> latencyHistogram[HISTOGRAM_BINS];
+
+/* Light stats, same bins as the light stats cluster */
+
+void app_stats_attribute_update()
+{
+    attributeUpdates++;
+}
+
+void app_stats_fade(uint32_t latency_us, uint32_t fade_time_ms, uint32_t coalesced)
+{
+    fadesStarted++;
+    fadesCoalesced += coalesced;
+    int bin = 0;
+    while (bin < HISTOGRAM_BINS - 1 && latency_us >= 250u << bin) {
+        bin++;
+    }
+    latencyHistogram[bin]++;
+}
+
+void app_stats_fade_dropped()
+{
+    fadesDropped++;
+}
+
+void app_stats_log_message()
+{
+}
+
+static bool read_capture(const char *file_name, std::vector<capture_record_t> &records)
+{
+    FILE *file = fopen(file_name, "r");
+    if (file == nullptr) {
+        perror(file_name);
+        return false;
+    }
+    char line[256];
+    bool inside = false;
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = 0;
+        if (strstr(line, CAPTURE_DUMP_END)) {
+            inside = false;
+        } else if (strstr(line, CAPTURE_DUMP_HEADER)) {
+            inside = true;
+            records.clear();
+        } else if (inside && strlen(line) == sizeof(capture_record_t) * 2) {
+            capture_record_t record;
+            uint8_t *data = (uint8_t *)&record;
+            for (size_t i = 0; i < sizeof(record); i++) {
+                unsigned byte;
+                if (sscanf(line + i * 2, "%2x", &byte) != 1) {
+                    fprintf(stderr, "Bad record: %s\n", line);
+                    fclose(file);
+                    return false;
+                }
+                data[i] = byte;
+            }
+            records.push_back(record);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-f] [-v] [-e endpoint] [-o timeline.csv] [-w warm K] [-c cold K] [-t K] [-l level] capture.txt\n"
+            "  -f  as fast as possible, instant fades, wall clock time\n"
+            "  -v  driver log\n"
+            "  -e  light endpoint id, default 1\n"
+            "  -o  PWM timeline CSV: time_us,channel,from_duty,to_duty,fade_ms\n"
+            "  -w, -c  warm and cold led color temperature, default 2200 and 7000\n"
+            "  -t, -l  initial color temperature and level, default 4600 and 64\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    bool timed = true;
+    uint16_t endpoint_id = 1;
+    const char *timeline_name = nullptr;
+    uint32_t warm = 2200;
+    uint32_t cold = 7000;
+    uint32_t kelvin = 4600;
+    uint8_t level = 64;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "fve:o:w:c:t:l:")) != -1) {
+        switch (opt) {
+        case 'f': timed = false; break;
+        case 'v': host_log_enabled = true; break;
+        case 'e': endpoint_id = atoi(optarg); break;
+        case 'o': timeline_name = optarg; break;
+        case 'w': warm = atoi(optarg); break;
+        case 'c': cold = atoi(optarg); break;
+        case 't': kelvin = atoi(optarg); break;
+        case 'l': level = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<capture_record_t> records;
+    if (!read_capture(argv[optind], records)) {
+        return 1;
+    }
+    if (records.empty()) {
+        fprintf(stderr, "No capture records\n");
+        return 1;
+    }
+
+    // Data model at startup
+    esp_matter_attr_val_t val = {};
+    val.val.u8 = (uint8_t)ColorControl::ColorMode::kColorTemperature;
+    host_set_attribute(ColorControl::Id, ColorControl::Attributes::ColorMode::Id, val);
+    val.val.u16 = REMAP_TO_RANGE_INVERSE(warm, MATTER_TEMPERATURE_FACTOR);
+    host_set_attribute(ColorControl::Id, ColorControl::Attributes::ColorTempPhysicalMaxMireds::Id, val);
+    val.val.u16 = REMAP_TO_RANGE_INVERSE(cold, MATTER_TEMPERATURE_FACTOR);
+    host_set_attribute(ColorControl::Id, ColorControl::Attributes::ColorTempPhysicalMinMireds::Id, val);
+    val.val.u16 = REMAP_TO_RANGE_INVERSE(kelvin, MATTER_TEMPERATURE_FACTOR);
+    host_set_attribute(ColorControl::Id, ColorControl::Attributes::ColorTemperatureMireds::Id, val);
+    val.val.b = DEFAULT_POWER;
+    host_set_attribute(OnOff::Id, OnOff::Attributes::OnOff::Id, val);
+    val.val.u8 = level;
+    host_set_attribute(LevelControl::Id, LevelControl::Attributes::CurrentLevel::Id, val);
+
+    host_init(timed);
+    app_driver_light_init();
+    app_driver_light_set_defaults(endpoint_id);
+    // Replay starts after the startup fades
+    int64_t startTime = host_finish();
+    size_t startupEvents = host_pwm_timeline().size();
+    attributeUpdates = 0;
+    fadesStarted = 0;
+    fadesCoalesced = 0;
+    fadesDropped = 0;
+    for (auto &bin : latencyHistogram) {
+        bin = 0;
+    }
+
+    // Replay, same filter as app_attribute_update_cb()
+    auto wallStart = std::chrono::steady_clock::now();
+    uint32_t lastTimestamp = records[0].timestamp;
+    int64_t recordTime = 0;
+    for (auto &record : records) {
+        // 32 bit us time stamps wrap, gaps are shorter
+        recordTime += uint32_t(record.timestamp - lastTimestamp);
+        lastTimestamp = record.timestamp;
+        if (timed) {
+            host_advance_to(startTime + recordTime);
+        }
+        if (record.type != esp_matter::attribute::PRE_UPDATE || record.endpoint_id != endpoint_id) {
+            continue;
+        }
+        esp_matter_attr_val_t attr_val = {};
+        attr_val.type = (esp_matter_val_type_t)record.val_type;
+        attr_val.val.u32 = record.value;
+        app_driver_attribute_update(record.cluster_id, record.attribute_id, &attr_val);
+        host_wait_idle();
+    }
+    host_finish();
+    double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    const auto &timeline = host_pwm_timeline();
+    if (timeline_name) {
+        FILE *file = fopen(timeline_name, "w");
+        if (file == nullptr) {
+            perror(timeline_name);
+            return 1;
+        }
+        fprintf(file, "time_us,channel,from_duty,to_duty,fade_ms\n");
+        for (size_t i = startupEvents; i < timeline.size(); i++) {
+            const auto &event = timeline[i];
+            fprintf(file, "%lld,%d,%u,%u,%d\n", (long long)event.time_us, event.channel,
+                    event.from_duty, event.to_duty, event.fade_time_ms);
+        }
+        fclose(file);
+    }
+
+    printf("mode: %s\n", timed ? "timed" : "fast");
+    printf("records: %zu\n", records.size());
+    printf("light updates: %u\n", attributeUpdates.load());
+    printf("capture time: %.3f s\n", recordTime / 1e6);
+    printf("wall time: %.3f s\n", wallTime);
+    printf("throughput: %.0f updates/s\n", wallTime > 0 ? attributeUpdates / wallTime : 0);
+    printf("fades started: %u\n", fadesStarted.load());
+    printf("fades coalesced: %u\n", fadesCoalesced.load());
+    printf("fades dropped: %u\n", fadesDropped.load());
+    printf("pwm events: %zu\n", timeline.size() - startupEvents);
+    printf("latency histogram (bin n < 250 us << n):");
+    for (auto &bin : latencyHistogram) {
+        printf(" %u", bin.load());
+    }
+    printf("\n");
+    return 0;
+}